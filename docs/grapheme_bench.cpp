@@ -0,0 +1,62 @@
+#include "utfgrapheme.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// u8 literals are char8_t from C++20 on; the samples are read as plain UTF-8 bytes
+template <typename T>
+const char* utf8_bytes(const T* text) { return reinterpret_cast<const char*>(text); }
+
+// Builds a corpus of about 'size' bytes by repeating the sample text
+string corpus(const string& sample, size_t size) {
+	string text;
+	while(text.size() < size)
+		text += sample;
+	return text;
+}
+
+template <typename F>
+void run(const char* name, const string& text, F fn) {
+	auto view = utf::make_stringview(text);
+	size_t result = 0;
+
+	auto start = chrono::steady_clock::now();
+	for(int i = 0; i != 10; ++i)
+		result += fn(view);
+	double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << "  " << name << ": " << result / 10 << " (" << (text.size() * 10 / secs / 1e6) << " MB/s)" << endl;
+}
+
+void bench(const char* name, const string& sample) {
+	string text = corpus(sample, 8 << 20);
+	cout << name << " (" << text.size() << " bytes)" << endl;
+
+	run("codepoints", text, [](const utf::stringview<const char*>& v) { return v.codepoints(); });
+	run("grapheme_length", text, [](const utf::stringview<const char*>& v) { return utf::grapheme_length(v); });
+	run("grapheme_iterator", text, [](const utf::stringview<const char*>& v) {
+		size_t n = 0;
+		for(auto cluster : utf::graphemes(v))
+			n += cluster.codeunits() != 0;
+		return n;
+	});
+}
+
+int main(int argc,const char* argv[]) {
+
+	// ZWJ sequences, skin tone modifiers, flags and keycaps mixed with short words
+	bench("emoji", utf8_bytes(u8"ok \U0001F468‍\U0001F469‍\U0001F467‍\U0001F466 family \U0001F44D\U0001F3FD "
+		u8"\U0001F1EF\U0001F1F5\U0001F1E9\U0001F1EA flags 1️⃣ \U0001F3F3️‍\U0001F308 "
+		u8"\U0001F9D1\U0001F3FB‍\U0001F4BB lol \U0001F602\U0001F602\U0001F602\n"));
+
+	// Devanagari, Bengali and Tamil: conjuncts, viramas and dependent vowel signs
+	bench("indic", utf8_bytes(u8"नमस्ते क्षितिज "
+		u8"हिन्दी বাংলা ক্ষ "
+		u8"தமிழ் வணக்கம்\n"));
+
+	// Baseline: ASCII only, served by the fast path
+	bench("ascii", "The quick brown fox jumps over the lazy dog.\r\n");
+}
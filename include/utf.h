@@ -16,37 +16,60 @@
 
 #include "utf_impl.h"
 #include <iterator>
+#include <algorithm>
+#include <string>
 
 #include <iostream>
 
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define UTF_HAS_STRING_VIEW
+#include <string_view>
+#endif
+
 namespace utf {
 
+	// Threading support lives in utf_parallel.h, so that only its users pay for <thread>
+	struct parallel_policy;
+
+	namespace impl {
+		template <typename Iter,typename E>
+		struct parallel_ops;
+	}
+
 	template <typename It>
-	class utf_iterator
-		: public std::iterator<std::input_iterator_tag,const codepoint_type,ptrdiff_t,const codepoint_type*,const codepoint_type&> {
+	class utf_iterator {
 			typedef typename std::iterator_traits<It>::value_type codeunit_type;
 			typedef typename impl::native_encoding<codeunit_type>::type encoding;
 			typedef impl::code_traits<encoding> traits_type;
 			codepoint_type val;
 			It pos;
+			It last;				// end of the text, decoding never reads past it
+			size_t len;				// length of the code point at pos once it has been decoded (0 before)
 
 	public:
-		explicit utf_iterator() : val(),pos() { }
-		explicit utf_iterator(It pos) : val(),pos(pos) { }
-		utf_iterator(const utf_iterator& it) : val(it.val),pos(it.pos) { }
+		typedef std::input_iterator_tag iterator_category;
+		typedef const codepoint_type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const codepoint_type* pointer;
+		typedef const codepoint_type& reference;
 
+		explicit utf_iterator() : val(),pos(),last(),len(0) { }
+		explicit utf_iterator(It pos,It last) : val(),pos(pos),last(last),len(0) { }
+		utf_iterator(const utf_iterator& it) : val(it.val),pos(it.pos),last(it.last),len(it.len) { }
+
+		// decoding also records the length, so the following ++ doesn't read the lead unit again
 		typename std::iterator_traits<utf_iterator>::reference operator*() {
-			val = traits_type::decode(pos);
+			len = traits_type::read(pos,last,val);
 			return val;
 		}
 		typename std::iterator_traits<utf_iterator>::pointer operator->() const { return (&**this); }
 		utf_iterator& operator++() {
-			It next = pos + traits_type::read_length(*pos);
-			pos = next;
+			pos += len ? len : traits_type::read(pos,last,val);
+			len = 0;
 			return *this;
 		}
 		utf_iterator operator++(int) {
-			codepoint_type tmp = *this;
+			utf_iterator tmp = *this;
 			++(*this);
 			return tmp;
 		}
@@ -67,9 +90,9 @@ namespace utf {
 
 		// returns iterators for on-the-fly decoding of a string
 		// from its current encoding to Unicode code points
-		utf_iterator<Iter> begin() const { return utf_iterator<Iter>(first); }
-		utf_iterator<Iter> end() const { return utf_iterator<Iter>(last); }
-		utf_iterator<Iter> at(int pos) const { return utf_iterator<Iter>(first + pos); }
+		utf_iterator<Iter> begin() const { return utf_iterator<Iter>(first,last); }
+		utf_iterator<Iter> end() const { return utf_iterator<Iter>(last,last); }
+		utf_iterator<Iter> at(int pos) const { return utf_iterator<Iter>(first + pos,last); }
 
 		// moves the stringview to focus on a different string
 		void refocus(const stringview<Iter>& view) {
@@ -80,24 +103,13 @@ namespace utf {
 			const_cast<Iter>(this->last) = end;
 		}
 
-		// check string's validity under it's current encoding
+		// check string's validity under it's current encoding (decodes and validates in one step, like codepoints and to)
 		bool validate() const {
-			typedef impl::code_traits<E> traits_t;
-			for(Iter it = first;  it < last;) {
-				size_t len = traits_t::read_length(*it);
-				if(last - it < static_cast<ptrdiff_t>(len)) {
-					return false;
-				}
-				if(!traits_t::validate(it,it + len)) {
-					return false;
-				}
-				codepoint_type cp = traits_t::decode(it);
-				if(!impl::validate_codepoint(cp)) {
-					return false;
-				}
-				it += len;
-			}
-			return true;
+			codepoint_type cp;
+			bool valid = true;
+			for(Iter it = first; valid && it < last;)
+				it += impl::code_traits<E>::read(it,last,cp,valid);
+			return valid;
 		}
 
 		// number of code points in current encoding
@@ -119,6 +131,9 @@ namespace utf {
 		// string length in current encoding
 		size_t codeunits() const { return last - first; }
 
+		// start of the underlying code unit sequence
+		Iter data() const { return first; }
+
 		// string length in future encoding
 		template <typename EDest>
 		size_t codeunits() const {
@@ -142,16 +157,67 @@ namespace utf {
 		// clean up code
 		int codeidx(int idx) {
 			if(idx == 0 || idx > (int)codeunits() || idx < 0 - (int)codeunits()) return this->codeunits();
-			auto marker = 0;
-			auto pointer = this->begin();
+			codepoint_type cp;
+			Iter pointer = first;
 			idx = (idx < 0) ? this->codeunits() + idx : idx - 1;
-			while(idx--) {
-				auto plus = impl::code_traits<E>::read_length(*pointer);
-				marker += plus;
-				for(; plus; --plus)
-					++pointer;
+			while(idx-- && pointer < last)
+				pointer += impl::code_traits<E>::read(pointer,last,cp);
+			return pointer - first;
+		}
+
+		// Returns the array position of the first occurence of the character c
+		// Returns codeunits() if c is not in the string
+		size_t find(codepoint_type c) const {
+			codepoint_type cp;
+			for(Iter it = first; it < last;) {
+				size_t len = impl::code_traits<E>::read(it,last,cp);
+				if(cp == c)
+					return it - first;
+				it += len;
 			}
-			return marker;
+			return codeunits();
+		}
+
+		// Returns the array position of the first occurence of the string needle (in the same encoding)
+		// Returns codeunits() if needle is not in the string
+		template <typename Iter2>
+		size_t find(const stringview<Iter2,E>& needle) const {
+			return std::search(first,last,needle.data(),needle.data() + needle.codeunits()) - first;
+		}
+
+		/*
+			* Parallel overloads (defined in utf_parallel.h, which must be included to call them)
+			* The string is split into pieces on code point boundaries, which are processed on
+			* up to policy.threads threads and then combined. Requires random access iterators
+			* Results match the serial functions for valid text
+			*/
+
+		bool validate(const parallel_policy& policy) const {
+			return impl::parallel_ops<Iter,E>::validate(*this,policy);
+		}
+
+		size_t codepoints(const parallel_policy& policy) const {
+			return impl::parallel_ops<Iter,E>::codepoints(*this,policy);
+		}
+
+		template <typename EDest>
+		size_t codeunits(const parallel_policy& policy) const {
+			return impl::parallel_ops<Iter,E>::template codeunits<EDest>(*this,policy);
+		}
+
+		// Encode the string in EDest. 'dest' must have room for codeunits<EDest>() code units
+		template <typename EDest,typename T>
+		T* to(const parallel_policy& policy,T* dest) const {
+			return impl::parallel_ops<Iter,E>::template to<EDest>(*this,policy,dest);
+		}
+
+		size_t find(const parallel_policy& policy,codepoint_type c) const {
+			return impl::parallel_ops<Iter,E>::find(*this,policy,c);
+		}
+
+		template <typename Iter2>
+		size_t find(const parallel_policy& policy,const stringview<Iter2,E>& needle) const {
+			return impl::parallel_ops<Iter,E>::find(*this,policy,needle);
 		}
 
 	private:
@@ -170,6 +236,19 @@ namespace utf {
 		return stringview<Iter>(first,last);
 	}
 
+	// views over std strings never copy; they are invalidated along with the string's storage
+	template <typename T>
+	stringview<const T*> make_stringview(const std::basic_string<T>& str) {
+		return stringview<const T*>(str.data(),str.data() + str.size());
+	}
+
+#ifdef UTF_HAS_STRING_VIEW
+	template <typename T>
+	stringview<const T*> make_stringview(std::basic_string_view<T> str) {
+		return stringview<const T*>(str.data(),str.data() + str.size());
+	}
+#endif
+
 }
 
 namespace std {
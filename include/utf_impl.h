@@ -11,6 +11,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 
 #ifdef UTFHPP_NO_CPP11
 namespace utf{
@@ -181,6 +182,63 @@ namespace utf {
 				}
 				return res;
 			}
+
+			/*
+				* DFA for decoding and validating in one pass (Bjoern Hoehrmann, http://bjoern.hoehrmann.de/utf-8/decoder/dfa/)
+				* The first 256 entries map a byte to its character class
+				* The rest is the transition table, indexed by state + class. States are multiples of 12
+				* 0 accepts a complete code point, 12 rejects, anything else expects more continuation bytes
+				*/
+			static const unsigned char* dfa() {
+				static const unsigned char table[] = {
+					0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+					0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+					0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+					0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+					1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+					7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+					8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+					10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
+
+					0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+					12,0,12,12,12,12,12,0,12,0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+					12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+					12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+					12,36,12,12,12,12,12,12,12,12,12,12,
+				};
+				return table;
+			}
+
+			// Decodes the code point at 'c' into 'cp' and returns its length, validating it on the way. Never reads at or past 'last'
+			// Invalid sequences decode to U+FFFD and consume the bytes read before the error (at least one)
+			// A sequence cut off by 'last' decodes to U+FFFD and consumes the rest of the text
+			template <typename Iter>
+			static size_t read(Iter c,Iter last,codepoint_type& cp) {
+				bool valid;
+				return read(c,last,cp,valid);
+			}
+
+			// As above, and sets 'valid' to whether the DFA accepted the sequence (U+FFFD itself is valid text)
+			template <typename Iter>
+			static size_t read(Iter c,Iter last,codepoint_type& cp,bool& valid) {
+				const unsigned char* table = dfa();
+				unsigned int state = 0;
+				size_t len = 0;
+				cp = 0;
+
+				do {
+					unsigned char byte = static_cast<unsigned char>(c[len++]);
+					unsigned int type = table[byte];
+					cp = state ? (byte & 0x3fu) | (cp << 6) : (0xffu >> type) & byte;
+					state = table[256 + state + type];
+				} while(state > 12 && c + len != last);
+
+				valid = state == 0;
+				if(valid) return len;
+
+				cp = 0xfffd;
+				return (state == 12 && len > 1) ? len - 1 : len;
+			}
 		};
 
 		template <>
@@ -261,6 +319,27 @@ namespace utf {
 				res += (trail - 0xdc00);
 				return res + 0x10000;
 			}
+
+			// Decodes the code point at 'c' into 'cp' and returns its length. Never reads at or past 'last'
+			// A lead surrogate without its trail decodes to U+FFFD and consumes one unit
+			template <typename Iter>
+			static size_t read(Iter c,Iter last,codepoint_type& cp) {
+				bool valid;
+				return read(c,last,cp,valid);
+			}
+
+			// As above, and sets 'valid' to whether the units form a code point (lone surrogates don't)
+			template <typename Iter>
+			static size_t read(Iter c,Iter last,codepoint_type& cp,bool& valid) {
+				if(read_length(*c) == 2 && (c + 1 == last || c[1] < 0xdc00 || c[1] >= 0xe000)) {
+					cp = 0xfffd;
+					valid = false;
+					return 1;
+				}
+				cp = decode(c);
+				valid = validate_codepoint(cp);
+				return read_length(*c);
+			}
 		};
 
 		template <>
@@ -290,6 +369,19 @@ namespace utf {
 			static codepoint_type decode(Iter c) {
 				return *c;
 			}
+
+			// Decodes the code point at 'c' into 'cp' and returns its length
+			template <typename Iter>
+			static size_t read(Iter c,Iter,codepoint_type& cp) {
+				cp = *c;
+				return 1;
+			}
+
+			template <typename Iter>
+			static size_t read(Iter c,Iter last,codepoint_type& cp,bool& valid) {
+				valid = validate_codepoint(*c);
+				return read(c,last,cp);
+			}
 		};
 	}
 }
@@ -0,0 +1,236 @@
+//          Copyright Grayson Hooper, 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//         http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "utf.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utf {
+
+	/*
+		* Passed to the parallel overloads of stringview's functions
+		* 'threads' is the number of threads to use (0 = one per hardware thread)
+		* 'grain' is the smallest piece, in code units, that is worth handing to a thread
+		*/
+	struct parallel_policy {
+		unsigned threads;
+		size_t grain;
+
+		explicit parallel_policy(unsigned threads = 0,size_t grain = 1 << 16) : threads(threads),grain(grain) { }
+	};
+
+	// Default policy: all hardware threads
+	const parallel_policy par;
+
+	namespace impl {
+
+		// Tells whether a code unit continues a code point (and so can't start a piece)
+		template <typename E>
+		struct trail_traits;
+
+		template <>
+		struct trail_traits<utf8_t> {
+			static bool is_trail(char c) { return (static_cast<unsigned char>(c) & 0xc0) == 0x80; }
+		};
+
+		template <>
+		struct trail_traits<utf16_t> {
+			static bool is_trail(char16_t c) { return c >= 0xdc00 && c < 0xe000; }
+		};
+
+		template <>
+		struct trail_traits<utf32_t> {
+			static bool is_trail(char32_t) { return false; }
+		};
+
+		inline unsigned thread_count(const parallel_policy& policy) {
+			unsigned n = policy.threads ? policy.threads : std::thread::hardware_concurrency();
+			return n ? n : 1;
+		}
+
+		/*
+			* Splits [first, last) into pieces that start on code point boundaries
+			* Returns the piece boundaries (pieces + 1 iterators)
+			* There are several pieces per thread so that threads finishing early can pick up more work
+			*/
+		template <typename E,typename Iter>
+		std::vector<Iter> split(Iter first,Iter last,const parallel_policy& policy) {
+			size_t units = last - first;
+			size_t pieces = units / (policy.grain ? policy.grain : 1);
+			size_t most = thread_count(policy) * 4;
+			if(pieces > most) pieces = most;
+			if(pieces == 0) pieces = 1;
+
+			std::vector<Iter> bounds(1,first);
+			for(size_t k = 1; k < pieces; ++k) {
+				Iter pos = first + units / pieces * k;
+				if(pos < bounds.back()) pos = bounds.back();
+				while(pos < last && trail_traits<E>::is_trail(*pos))
+					++pos;
+				bounds.push_back(pos);
+			}
+			bounds.push_back(last);
+			return bounds;
+		}
+
+		// Lowers 'value' to 'candidate' if candidate is smaller
+		inline void atomic_min(std::atomic<size_t>& value,size_t candidate) {
+			size_t current = value;
+			while(candidate < current && !value.compare_exchange_weak(current,candidate)) { }
+		}
+
+		/*
+			* Runs fn(k) for every k in [0, pieces). Threads claim the next unclaimed piece until none are left
+			* If fn throws, no more pieces are handed out and the first exception is rethrown on the calling thread
+			* once every worker has been joined. If threads can't be started, the ones that did (and the caller) do the work
+			*/
+		template <typename F>
+		void parallel_for(const parallel_policy& policy,size_t pieces,F fn) {
+			std::atomic<size_t> next(0);
+			std::exception_ptr error;
+			std::mutex lock;
+			auto work = [&]() {
+				try {
+					for(size_t k = next++; k < pieces; k = next++)
+						fn(k);
+				} catch(...) {
+					std::lock_guard<std::mutex> guard(lock);
+					if(!error) error = std::current_exception();
+					next = pieces;
+				}
+			};
+
+			size_t n = thread_count(policy);
+			if(n > pieces) n = pieces;
+
+			std::vector<std::thread> workers;
+			try {
+				workers.reserve(n);						// emplace_back can't reallocate past a started thread
+				for(size_t t = 1; t < n; ++t)
+					workers.emplace_back(work);
+			} catch(...) { }
+			work();
+			for(auto& worker : workers)
+				worker.join();
+
+			if(error) std::rethrow_exception(error);
+		}
+
+		// Bodies of stringview's parallel overloads
+		template <typename Iter,typename E>
+		struct parallel_ops {
+			typedef stringview<Iter,E> view_type;
+
+			static bool validate(const view_type& view,const parallel_policy& policy) {
+				std::vector<Iter> bounds = split<E>(view.data(),view.data() + view.codeunits(),policy);
+				std::atomic<bool> valid(true);
+				parallel_for(policy,bounds.size() - 1,[&](size_t k) {
+					if(valid && !view_type(bounds[k],bounds[k + 1]).validate())
+						valid = false;
+				});
+				return valid;
+			}
+
+			static size_t codepoints(const view_type& view,const parallel_policy& policy) {
+				std::vector<Iter> bounds = split<E>(view.data(),view.data() + view.codeunits(),policy);
+				std::atomic<size_t> cps(0);
+				parallel_for(policy,bounds.size() - 1,[&](size_t k) {
+					size_t n = 0;
+					codepoint_type cp;
+					for(Iter it = bounds[k]; it < bounds[k + 1]; it += code_traits<E>::read(it,bounds[k + 1],cp))
+						++n;
+					cps += n;
+				});
+				return cps;
+			}
+
+			template <typename EDest>
+			static size_t codeunits(const view_type& view,const parallel_policy& policy) {
+				std::vector<Iter> bounds = split<E>(view.data(),view.data() + view.codeunits(),policy);
+				std::atomic<size_t> cus(0);
+				parallel_for(policy,bounds.size() - 1,[&](size_t k) {
+					cus += piece_units<EDest>(bounds[k],bounds[k + 1]);
+				});
+				return cus;
+			}
+
+			template <typename EDest,typename T>
+			static T* to(const view_type& view,const parallel_policy& policy,T* dest) {
+				std::vector<Iter> bounds = split<E>(view.data(),view.data() + view.codeunits(),policy);
+				size_t pieces = bounds.size() - 1;
+
+				// size every piece, then let each piece encode into its own slice of dest
+				std::vector<size_t> offsets(pieces + 1,0);
+				parallel_for(policy,pieces,[&](size_t k) {
+					offsets[k + 1] = piece_units<EDest>(bounds[k],bounds[k + 1]);
+				});
+				for(size_t k = 0; k != pieces; ++k)
+					offsets[k + 1] += offsets[k];
+
+				parallel_for(policy,pieces,[&](size_t k) {
+					T* out = dest + offsets[k];
+					codepoint_type cp;
+					for(Iter it = bounds[k]; it < bounds[k + 1]; out = code_traits<EDest>::encode(cp,out))
+						it += code_traits<E>::read(it,bounds[k + 1],cp);
+				});
+				return dest + offsets[pieces];
+			}
+
+			static size_t find(const view_type& view,const parallel_policy& policy,codepoint_type c) {
+				Iter first = view.data();
+				std::vector<Iter> bounds = split<E>(first,first + view.codeunits(),policy);
+				std::atomic<size_t> best(view.codeunits());
+				parallel_for(policy,bounds.size() - 1,[&](size_t k) {
+					size_t start = bounds[k] - first;
+					if(start >= best) return;							// an earlier piece already matched
+
+					size_t pos = view_type(bounds[k],bounds[k + 1]).find(c);
+					if(bounds[k] + pos != bounds[k + 1])
+						atomic_min(best,start + pos);
+				});
+				return best;
+			}
+
+			template <typename Iter2>
+			static size_t find(const view_type& view,const parallel_policy& policy,const stringview<Iter2,E>& needle) {
+				size_t len = needle.codeunits();
+				if(len == 0) return 0;
+
+				Iter first = view.data(), last = first + view.codeunits();
+				std::vector<Iter> bounds = split<E>(first,last,policy);
+				std::atomic<size_t> best(view.codeunits());
+				parallel_for(policy,bounds.size() - 1,[&](size_t k) {
+					size_t start = bounds[k] - first;
+					if(start >= best) return;
+
+					// matches must start in this piece but may run into the next one
+					Iter stop = (size_t)(last - bounds[k + 1]) > len ? bounds[k + 1] + len : last;
+					Iter match = std::search(bounds[k],stop,needle.data(),needle.data() + len);
+					if(match < bounds[k + 1])
+						atomic_min(best,match - first);
+				});
+				return best;
+			}
+
+		private:
+			// EDest code units needed for the piece [b, e). Never steps past e
+			template <typename EDest>
+			static size_t piece_units(Iter b,Iter e) {
+				size_t cus = 0;
+				codepoint_type cp;
+				for(Iter it = b; it < e; cus += code_traits<EDest>::write_length(cp))
+					it += code_traits<E>::read(it,e,cp);
+				return cus;
+			}
+		};
+	}
+}
@@ -0,0 +1,182 @@
+//          Copyright Grayson Hooper, 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//         http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "utfstring.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace utf {
+
+	namespace impl {
+
+		// Uniform access to the kinds of text a batch can be built from
+		template <typename Iter,typename E>
+		stringview<Iter,E> view_of(const stringview<Iter,E>& view) { return view; }
+
+		template <typename T>
+		stringview<const T*> view_of(const std::basic_string<T>& str) { return make_stringview(str); }
+
+#ifdef UTF_HAS_STRING_VIEW
+		template <typename T>
+		stringview<const T*> view_of(std::basic_string_view<T> str) { return make_stringview(str); }
+#endif
+
+		// the string's terminating null unit is left out; the column adds its own
+		template <typename T>
+		stringview<const T*> view_of(string<T>& str) {
+			const T* _text = static_cast<const T*>(str);
+			size_t size = str.strsize();
+			if(size && _text[size - 1] == T(0)) --size;
+			return stringview<const T*>(_text,_text + size);
+		}
+
+		// True if a view of type View can be copied into a string<ch> without transcoding
+		template <typename ch,typename View>
+		struct is_native_view : std::is_same<View,stringview<const ch*,typename encoding_for_size<sizeof(ch)>::type>> { };
+
+		// Code units below 0x80 are a single ASCII character in every encoding
+		template <typename T>
+		bool is_ascii(T c) {
+			return static_cast<typename std::make_unsigned<T>::type>(c) < 0x80;
+		}
+
+		// Number of EDest code units needed for 'src'. ASCII runs are counted without decoding
+		template <typename EDest,typename Iter,typename E>
+		size_t batch_units(const stringview<Iter,E>& src,std::false_type) {
+			Iter it = src.data(), last = it + src.codeunits();
+			size_t cus = 0;
+			while(it != last) {
+				if(is_ascii(*it)) {
+					++cus;
+					++it;
+					continue;
+				}
+				codepoint_type cp;
+				it += code_traits<E>::read(it,last,cp);
+				cus += code_traits<EDest>::write_length(cp);
+			}
+			return cus;
+		}
+
+		template <typename EDest,typename Iter,typename E>
+		size_t batch_units(const stringview<Iter,E>& src,std::true_type) {
+			return src.codeunits();
+		}
+
+		// Transcodes 'src' into 'dest'. ASCII runs are copied unit for unit without decoding
+		template <typename EDest,typename Iter,typename E,typename T>
+		T* batch_encode(const stringview<Iter,E>& src,T* dest,std::false_type) {
+			Iter it = src.data(), last = it + src.codeunits();
+			while(it != last) {
+				while(it != last && is_ascii(*it))
+					*dest++ = static_cast<T>(*it++);
+				if(it == last) break;
+
+				codepoint_type cp;
+				it += code_traits<E>::read(it,last,cp);
+				dest = code_traits<EDest>::encode(cp,dest);
+			}
+			return dest;
+		}
+
+		// Same encoding and contiguous storage, copied as is
+		template <typename EDest,typename Iter,typename E,typename T>
+		T* batch_encode(const stringview<Iter,E>& src,T* dest,std::true_type) {
+			std::memcpy(dest,src.data(),src.bytes());
+			return dest + src.codeunits();
+		}
+	}
+
+	/*
+		* utf::column holds many strings of one encoding in a single contiguous buffer.
+		* Field i occupies the code units [offset(i), offset(i + 1) - 1) of the buffer, followed by a null unit.
+		* Fields are indexed from 0 like any other container. Character indices inside a field follow utf::string.
+		* Views and slices handed out by a column borrow its buffer and must not outlive it.
+		*/
+
+	template <typename ch>
+	class column {
+		private:
+			ch* text;
+			size_t* offsets;			// count + 1 entries
+			size_t count;
+
+			template <typename c,typename FwdIt>
+			friend column<c> transcode_batch(FwdIt first,FwdIt last);
+
+			column(size_t n) : text(nullptr),offsets(new size_t[n + 1]),count(n) {
+				offsets[0] = 0;
+			}
+
+			column(const column&);
+			column& operator=(const column&);
+
+		public:
+			column(column&& col) : text(col.text),offsets(col.offsets),count(col.count) {
+				col.text = nullptr;
+				col.offsets = nullptr;
+				col.count = 0;
+			}
+
+			~column() {
+				delete[] text;
+				delete[] offsets;
+			}
+
+			// number of fields
+			size_t size() const { return count; }
+
+			// total code units in the buffer (each field's text plus its null unit)
+			size_t codeunits() const { return offsets ? offsets[count] : 0; }
+
+			// code unit position of field 'i' in the buffer. offset(size()) is the end of the buffer
+			size_t offset(size_t i) const { return offsets[i]; }
+
+			const ch* data() const { return text; }
+
+			// Non-owning view of field 'i' (without the null unit)
+			stringview<const ch*> operator[](size_t i) const {
+				return stringview<const ch*>(text + offsets[i],text + offsets[i + 1] - 1);
+			}
+
+			// utf::string over field 'i' that borrows the column's buffer (no allocation, the null unit is its terminator)
+			string<ch> slice(size_t i) const {
+				return string<ch>(text + offsets[i],offsets[i + 1] - offsets[i],nullptr);
+			}
+	};
+
+	/*
+		* Transcodes every string in [first, last) into one utf::column<ch>
+		* The elements may be utf::strings, stringviews or std::basic_strings of any encoding
+		* Costs two passes over the input (sizing and encoding) and exactly two allocations
+		*/
+	template <typename ch,typename FwdIt>
+	column<ch> transcode_batch(FwdIt first,FwdIt last) {
+		typedef typename impl::encoding_for_size<sizeof(ch)>::type chartype;
+
+		column<ch> col(std::distance(first,last));
+
+		size_t i = 0;
+		for(FwdIt it = first; it != last; ++it, ++i) {
+			auto view = impl::view_of(*it);
+			col.offsets[i + 1] = col.offsets[i] + impl::batch_units<chartype>(view,impl::is_native_view<ch,decltype(view)>()) + 1;
+		}
+
+		col.text = new ch[col.offsets[col.count]];
+
+		ch* dest = col.text;
+		for(FwdIt it = first; it != last; ++it) {
+			auto view = impl::view_of(*it);
+			dest = impl::batch_encode<chartype>(view,dest,impl::is_native_view<ch,decltype(view)>());
+			*dest++ = ch(0);
+		}
+
+		return col;
+	}
+
+}
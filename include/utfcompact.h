@@ -0,0 +1,281 @@
+//          Copyright Grayson Hooper, 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//         http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "utfstring.h"
+
+#include <cstring>				// memcpy for same-width conversions
+
+namespace utf {
+
+	/*
+		* utf::compact_string is an immutable string that stores its text as fixed-width code points.
+		* The width is picked on construction, from a single decoding pass over the text, as the narrowest that fits:
+		*   1 byte  (Latin-1) if every code point is below U+0100
+		*   2 bytes (UCS-2)   if every code point is in the Basic Multilingual Plane
+		*   4 bytes (UTF-32)  otherwise
+		* Since every character has the same width, 'at' and 'substr' are O(1) in the character index.
+		* Indexing follows utf::string: 1-indexed by default, negative indices count from the back.
+		*/
+
+	class compact_string {
+		private:
+			// Storage for the three possible widths. Which member is live is determined by 'width'
+			union storage {
+				unsigned char* latin1;
+				char16_t* ucs2;
+				char32_t* ucs4;
+			};
+
+			storage data;
+			size_t len;					// number of code points
+			unsigned char width;		// bytes per code point (1, 2 or 4)
+
+			// Allocates room for 'n' code points at the current width
+			void allocate(size_t n) {
+				switch(width) {
+					case 1: data.latin1 = new unsigned char[n]; break;
+					case 2: data.ucs2 = new char16_t[n]; break;
+					default: data.ucs4 = new char32_t[n]; break;
+				}
+			}
+
+			void release() {
+				switch(width) {
+					case 1: delete[] data.latin1; break;
+					case 2: delete[] data.ucs2; break;
+					default: delete[] data.ucs4; break;
+				}
+				data.ucs4 = nullptr;
+			}
+
+			const void* raw() const {
+				switch(width) {
+					case 1: return data.latin1;
+					case 2: return data.ucs2;
+					default: return data.ucs4;
+				}
+			}
+
+			// Returns the code point at the 0-based position 'i'
+			codepoint_type get(size_t i) const {
+				switch(width) {
+					case 1: return data.latin1[i];
+					case 2: return data.ucs2[i];
+					default: return data.ucs4[i];
+				}
+			}
+
+			// Converts a 1-indexed (or negative) character index into a 0-based position
+			size_t position(int idx) const {
+				if(idx == 0 || idx > (int)len || idx < 0 - (int)len) throw("Error: invalid index");
+				return (idx < 0) ? len + idx : idx - 1;
+			}
+
+			// Copies 'n' UTF-32 code points into a new array of the (narrower) storage type T
+			template <typename T>
+			static T* narrow(const char32_t* src,size_t n) {
+				T* dest = new T[n];
+				for(size_t i = 0; i != n; ++i)
+					dest[i] = static_cast<T>(src[i]);
+				return dest;
+			}
+
+			// Internal code chunk to decode the source text once, pick the storage width and store the text
+			// The text is decoded into UTF-32 (a code point never takes less than one code unit, so codeunits() is enough room)
+			// which is kept as is for 4 byte storage and narrowed without decoding again otherwise
+			template <typename Iter,typename E>
+			void rawAssign(const stringview<Iter,E>& src) {
+				char32_t* wide = new char32_t[src.codeunits()];
+
+				// OR-ing every code point together gives a value below 0x100 (0x10000) iff all of them are
+				codepoint_type widest = 0;
+				len = 0;
+				for(auto cp : src) {
+					widest |= cp;
+					wide[len++] = cp;
+				}
+
+				width = (widest < 0x100) ? 1 : (widest < 0x10000) ? 2 : 4;
+				switch(width) {
+					case 1: data.latin1 = narrow<unsigned char>(wide,len); delete[] wide; break;
+					case 2: data.ucs2 = narrow<char16_t>(wide,len); delete[] wide; break;
+					default: data.ucs4 = wide; break;
+				}
+			}
+
+			// Creates an empty string of the given width, used by substr
+			compact_string(size_t n,unsigned char w) : len(n),width(w) {
+				allocate(n);
+			}
+
+		public:
+			/*
+			Read-only iterator over the code points of a compact_string
+			*/
+			class const_iterator
+				: public std::iterator<std::input_iterator_tag,const codepoint_type,ptrdiff_t,const codepoint_type*,codepoint_type> {
+					const compact_string* str;
+					size_t pos;
+
+				public:
+					const_iterator() : str(nullptr),pos(0) { }
+					const_iterator(const compact_string* str,size_t pos) : str(str),pos(pos) { }
+
+					codepoint_type operator*() const { return str->get(pos); }
+					const_iterator& operator++() {
+						++pos;
+						return *this;
+					}
+					const_iterator operator++(int) {
+						const_iterator tmp = *this;
+						++pos;
+						return tmp;
+					}
+					friend bool operator != (const_iterator lhs,const_iterator rhs) { return lhs.pos != rhs.pos; }
+					friend bool operator == (const_iterator lhs,const_iterator rhs) { return !(lhs != rhs); }
+			};
+
+			// constructors
+			template <typename dchar,size_t N>
+			compact_string(const dchar(&_text)[N]) {						// Text Literal
+				rawAssign(make_stringview(_text));
+			}
+			template <typename dchar>
+			compact_string(const dchar* _text,size_t N) {					// C-style string
+				rawAssign(make_stringview(_text,_text + N));
+			}
+			template <typename dchar>
+			compact_string(string<dchar>& str) {							// Encoding converter
+				const dchar* _text = static_cast<const dchar*>(str);
+				rawAssign(make_stringview(_text,_text + str.strsize()));
+			}
+			template <typename Iter,typename E>
+			explicit compact_string(const stringview<Iter,E>& view) {		// Any stringview
+				rawAssign(view);
+			}
+
+			compact_string(const compact_string& str) : len(str.len),width(str.width) {
+				allocate(len);
+				std::memcpy(const_cast<void*>(raw()),str.raw(),len * width);
+			}
+			compact_string(compact_string&& str) : data(str.data),len(str.len),width(str.width) {
+				str.data.ucs4 = nullptr;
+				str.len = 0;
+			}
+
+			// destructor
+			~compact_string() { release(); }
+
+			// string info functions
+
+			// The number of characters in a string
+			int length() const { return len; }
+
+			// Bytes used to store each character (1, 2 or 4)
+			int charsize() const { return width; }
+
+			const char* encoding() const {
+				switch(width) {
+					case 1: return "Latin-1";
+					case 2: return "UCS-2";
+					default: return "UTF-32";
+				}
+			}
+
+			// Gives the array size of the string in the specified encoding
+			template <typename dchar>
+			size_t strsize() const {
+				typedef typename impl::encoding_for_size<sizeof(dchar)>::type dchartype;
+
+				if(width == sizeof(dchar) && width != 1) return len;		// UCS-2 -> UTF-16 and UTF-32 -> UTF-32 are 1:1
+
+				size_t cus = 0;
+				for(size_t i = 0; i != len; ++i)
+					cus += impl::code_traits<dchartype>::write_length(get(i));
+				return cus;
+			}
+
+			// Returns the character at the given (1-indexed) index
+			codepoint_type at(int idx) const {
+				return get(position(idx));
+			}
+
+			// conversion functions
+
+			// Encode the string in EDest
+			template <typename EDest,typename OutIt>
+			OutIt encode(OutIt dest) const {
+				for(size_t i = 0; i != len; ++i)
+					dest = impl::code_traits<EDest>::encode(get(i),dest);
+				return dest;
+			}
+
+			// Converts the string into a utf::string of the desired encoding
+			template <typename dchar>
+			string<dchar> to() const {
+				typedef typename impl::encoding_for_size<sizeof(dchar)>::type dchartype;
+
+				size_t N = strsize<dchar>();
+				dchar* _text = new dchar[N];
+
+				if(width == sizeof(dchar) && width != 1)
+					std::memcpy(_text,raw(),len * width);
+				else
+					encode<dchartype>(_text);
+
+				return string<dchar>(_text,_text + N);
+			}
+
+			// text manipulation functions
+
+			/*
+				* Creates a substring from the character index 'idx_b' to character index 'idx_e' (inclusive)
+				* Uses the same indexing rules as utf::string::substr, but runs in O(1) + the cost of the copy
+				* The substring keeps the width of its parent
+				*/
+			compact_string substr(int idx_b = 1,int idx_e = -1) const {
+				size_t first = position(idx_b), last = position(idx_e);
+				if(first > last) throw("Error: invalid index range");
+
+				compact_string sub(last - first + 1,width);
+				std::memcpy(const_cast<void*>(sub.raw()),static_cast<const char*>(raw()) + first * width,sub.len * width);
+				return sub;
+			}
+
+			// boolean operators
+
+			bool operator==(const compact_string& str) const {
+				if(len != str.len) return false;
+				if(width == str.width) return std::memcmp(raw(),str.raw(),len * width) == 0;
+
+				for(size_t i = 0; i != len; ++i)
+					if(get(i) != str.get(i))
+						return false;
+
+				return true;
+			}
+
+			bool operator!=(const compact_string& str) const {
+				return !operator==(str);
+			}
+
+			// assignment operators
+
+			compact_string& operator=(compact_string str) {
+				std::swap(data,str.data);
+				std::swap(len,str.len);
+				std::swap(width,str.width);
+				return *this;
+			}
+
+			// other functions
+
+			const_iterator begin() const { return const_iterator(this,0); }
+			const_iterator end() const { return const_iterator(this,len); }
+	};
+
+}
@@ -0,0 +1,171 @@
+//          Copyright Grayson Hooper, 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//         http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "utf.h"
+#include "utf_grapheme_tables.h"		// generated by tools/gen_grapheme_tables.py
+
+namespace utf {
+
+	namespace impl {
+
+		// Grapheme break property of a code point (two table lookups, none for ASCII)
+		inline grapheme_break grapheme_property(codepoint_type c) {
+			if(c < 0x80) {
+				if(c >= 0x20 && c != 0x7f) return gb_other;
+				if(c == '\r') return gb_cr;
+				if(c == '\n') return gb_lf;
+				return gb_control;
+			}
+			if(c >= 0x110000) return gb_other;
+			return static_cast<grapheme_break>(grapheme_stage2[grapheme_stage1[c / grapheme_block] * grapheme_block + c % grapheme_block]);
+		}
+
+		/*
+			* State carried across a cluster for the rules that look further back than one code point
+			*   pictographic: the cluster so far ends in Extended_Pictographic Extend* (GB11)
+			*   regional: number of Regional_Indicators ending the cluster so far (GB12, GB13)
+			*/
+		struct grapheme_state {
+			grapheme_break prev;
+			bool pictographic;
+			size_t regional;
+
+			explicit grapheme_state(grapheme_break first)
+				: prev(first),pictographic(first == gb_extended_pictographic),regional(first == gb_regional_indicator) { }
+
+			// Whether 'next' continues the cluster (UAX #29 rules GB3 - GB999). Updates the state when it does
+			bool extend(grapheme_break next) {
+				bool join;
+				if(prev == gb_cr && next == gb_lf) join = true;											// GB3
+				else if(prev == gb_cr || prev == gb_lf || prev == gb_control) join = false;				// GB4
+				else if(next == gb_cr || next == gb_lf || next == gb_control) join = false;				// GB5
+				else if(prev == gb_l && (next == gb_l || next == gb_v || next == gb_lv || next == gb_lvt)) join = true;	// GB6
+				else if((prev == gb_lv || prev == gb_v) && (next == gb_v || next == gb_t)) join = true;	// GB7
+				else if((prev == gb_lvt || prev == gb_t) && next == gb_t) join = true;					// GB8
+				else if(next == gb_extend || next == gb_zwj || next == gb_spacingmark) join = true;		// GB9, GB9a
+				else if(prev == gb_prepend) join = true;												// GB9b
+				else if(prev == gb_zwj && pictographic && next == gb_extended_pictographic) join = true;	// GB11
+				else if(prev == gb_regional_indicator && next == gb_regional_indicator) join = regional % 2 == 1;	// GB12, GB13
+				else join = false;																		// GB999
+
+				if(join) {
+					if(next == gb_extended_pictographic) pictographic = true;
+					else if(next != gb_extend && next != gb_zwj) pictographic = false;
+					if(prev == gb_zwj && next != gb_extended_pictographic) pictographic = false;
+					regional = (next == gb_regional_indicator) ? regional + 1 : 0;
+					prev = next;
+				}
+				return join;
+			}
+		};
+
+		// Returns the end of the grapheme cluster starting at 'pos' (which must be before 'last')
+		template <typename E,typename Iter>
+		Iter grapheme_end(Iter pos,Iter last) {
+			typedef code_traits<E> traits_t;
+			typedef typename std::make_unsigned<typename std::iterator_traits<Iter>::value_type>::type unit;
+
+			codepoint_type cp;
+			pos += traits_t::read(pos,last,cp);
+
+			// ASCII fast path: only CR LF joins two ASCII characters
+			if(pos == last) return pos;
+			if(cp < 0x80 && cp != '\r' && static_cast<unit>(*pos) < 0x80) return pos;
+
+			grapheme_state state(grapheme_property(cp));
+			while(pos < last) {
+				size_t len = traits_t::read(pos,last,cp);
+				if(!state.extend(grapheme_property(cp)))
+					break;
+				pos += len;
+			}
+			return pos;
+		}
+	}
+
+	/*
+		* Iterates over the extended grapheme clusters (user-perceived characters) of a string
+		* Each cluster is returned as a stringview over the original text
+		*/
+	template <typename Iter,typename E = typename impl::native_encoding<typename std::iterator_traits<Iter>::value_type>::type>
+	class grapheme_iterator {
+			Iter pos;
+			Iter next;				// end of the cluster at pos
+			Iter last;
+
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef stringview<Iter,E> value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const stringview<Iter,E>* pointer;
+			typedef stringview<Iter,E> reference;
+
+			grapheme_iterator(Iter pos,Iter last) : pos(pos),next(pos < last ? impl::grapheme_end<E>(pos,last) : last),last(last) { }
+
+			stringview<Iter,E> operator*() const { return stringview<Iter,E>(pos,next); }
+			grapheme_iterator& operator++() {
+				pos = next;
+				if(pos < last) next = impl::grapheme_end<E>(pos,last);
+				return *this;
+			}
+			grapheme_iterator operator++(int) {
+				grapheme_iterator tmp = *this;
+				++(*this);
+				return tmp;
+			}
+			friend bool operator != (const grapheme_iterator& lhs,const grapheme_iterator& rhs) { return lhs.pos != rhs.pos; }
+			friend bool operator == (const grapheme_iterator& lhs,const grapheme_iterator& rhs) { return !(lhs != rhs); }
+	};
+
+	// Range over the grapheme clusters of a stringview (for use in ranged for loops)
+	template <typename Iter,typename E>
+	struct grapheme_range {
+		Iter first, last;
+
+		grapheme_iterator<Iter,E> begin() const { return grapheme_iterator<Iter,E>(first,last); }
+		grapheme_iterator<Iter,E> end() const { return grapheme_iterator<Iter,E>(last,last); }
+	};
+
+	template <typename Iter,typename E>
+	grapheme_range<Iter,E> graphemes(const stringview<Iter,E>& view) {
+		grapheme_range<Iter,E> range = { view.data(),view.data() + view.codeunits() };
+		return range;
+	}
+
+	// number of grapheme clusters in the string
+	template <typename Iter,typename E>
+	size_t grapheme_length(const stringview<Iter,E>& view) {
+		size_t n = 0;
+		for(Iter pos = view.data(), last = pos + view.codeunits(); pos < last; ++n)
+			pos = impl::grapheme_end<E>(pos,last);
+		return n;
+	}
+
+	/*
+		* Returns the clusters from index 'idx_b' to index 'idx_e' (inclusive) as a view over the same text
+		* Indexing follows utf::string::substr: 1-indexed, negative indices count from the back
+		* Negative indices need a full pass to count the clusters first
+		*/
+	template <typename Iter,typename E>
+	stringview<Iter,E> grapheme_substr(const stringview<Iter,E>& view,int idx_b = 1,int idx_e = -1) {
+		if(idx_b < 0 || idx_e < 0) {
+			int n = (int)grapheme_length(view);
+			if(idx_b < 0) idx_b += n + 1;
+			if(idx_e < 0) idx_e += n + 1;
+		}
+		if(idx_b < 1 || idx_e < idx_b) throw("Error: invalid index range");
+
+		Iter pos = view.data(), last = pos + view.codeunits(), start = last;
+		for(int i = 1; i <= idx_e; ++i) {
+			if(!(pos < last)) throw("Error: invalid index range");
+			if(i == idx_b) start = pos;
+			pos = impl::grapheme_end<E>(pos,last);
+		}
+		return stringview<Iter,E>(start,pos);
+	}
+
+}
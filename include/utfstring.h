@@ -8,14 +8,60 @@
 #include "utf.h"
 
 // remove for release
-#include <iostream>				// Operator<< overload on basic_ostream
-#include <string>				// Deprecated 'assign' overload
+#include <iostream>				// Stream operator overloads on basic_ostream/basic_istream
+#include <string>				// std::basic_string constructors, deprecated 'assign' overload
+#include <memory>				// unique_ptr adoption
+#include <cstring>				// memcpy for same-encoding copies
+#include <type_traits>
+
+#ifndef UTFSTRING_NO_MEMO
+#include <atomic>				// Memoized conversions
+#include <mutex>
+#endif
 
 namespace utf {
 
+	namespace impl {
+
+		// Owns an adopted unique_ptr (and so its deleter) until the string holding the buffer releases it
+		struct buffer_owner {
+			virtual ~buffer_owner() { }
+		};
+
+		template <typename ch,typename D>
+		struct adopted_buffer : buffer_owner {
+			std::unique_ptr<ch[], D> buf;
+
+			adopted_buffer(std::unique_ptr<ch[], D>&& buf) : buf(std::move(buf)) { }
+		};
+	}
+
+#ifndef UTFSTRING_NO_MEMO
+	namespace impl {
+
+		/*
+			* Converted copies of a string, one slot per code unit size (slot = size / 2: UTF-8, UTF-16, UTF-32)
+			* A slot is only filled by string::cached, at most once, and kept until the string changes
+			* 'ready' is set once a slot's size and text can be read
+			*/
+		struct memo {
+			std::once_flag filled[3];
+			std::atomic<bool> ready[3];
+			size_t size[3];
+			void* text[3];
+
+			memo() : ready(),size(),text() { }
+			~memo() {
+				delete[] static_cast<char*>(text[0]);
+				delete[] static_cast<char16_t*>(text[1]);
+				delete[] static_cast<char32_t*>(text[2]);
+			}
+		};
+	}
+#endif
+
 	// Move operators outside of class
 	// Add more operator overloads
-	// Change functions to make use of move semantics
 
 	/*
 		* utf::string is an immutable, unicode friendly string class.
@@ -23,6 +69,7 @@ namespace utf {
 		* All string operations, with the exception of assign and operator=, do not modify the
 		* Internal text string in any way. Rather if a function "modifies" the string, it instead
 		* Returns a new string that has had the desired modifications applied to it.
+		* When called on an r-value (std::move(s).cut(...)), the new string takes over s's buffer instead
 		*/
 
 	template <typename ch>
@@ -47,16 +94,153 @@ namespace utf {
 				return (view.codeidx(idx1) < view.codeidx(idx2));
 			}
 
+			// Default deleter for text allocated by the string itself
+			static void free_text(ch* _text) { delete[] _text; }
+
+			// Takes over a unique_ptr's buffer. Plain deleters are stored directly, anything else (stateful
+			// deleters, lambdas) is kept alive inside an owner along with the unique_ptr itself
+			void adopt(std::unique_ptr<ch[]>& buf) {
+				buf.release();
+				deleter = &free_text;
+			}
+			void adopt(std::unique_ptr<ch[], void (*)(ch*)>& buf) {
+				deleter = buf.get_deleter();
+				buf.release();
+			}
+			template <typename D>
+			void adopt(std::unique_ptr<ch[], D>& buf) {
+				owner = new impl::adopted_buffer<ch,D>(std::move(buf));
+			}
+
+			// Whether the string may write to and free its buffer
+			bool owns() const { return deleter || owner; }
+
 		protected:
 			ch* text;
 			stringview<const ch*> view;
+			void (*deleter)(ch*);				// releases 'text'. nullptr if the buffer is borrowed or held by 'owner'
+			impl::buffer_owner* owner = nullptr;	// holds an adopted unique_ptr with a non-trivial deleter
+			size_t capacity;					// code units available in 'text' (>= view.codeunits())
+
+#ifndef UTFSTRING_NO_MEMO
+			std::atomic<impl::memo*> cache{ nullptr };		// converted copies, created by the first call to cached
+
+			// Returns the memo, creating it if needed. Concurrent callers all get the same one
+			impl::memo& memo() {
+				impl::memo* m = cache.load(std::memory_order_acquire);
+				if(!m) {
+					impl::memo* fresh = new impl::memo;
+					if(cache.compare_exchange_strong(m, fresh, std::memory_order_acq_rel))
+						m = fresh;
+					else
+						delete fresh;
+				}
+				return *m;
+			}
+
+			// The conversion kept by cached<dchar>(), or nullptr if there isn't one yet (never converts)
+			template <typename dchar>
+			const dchar* memoized() {
+				impl::memo* m = cache.load(std::memory_order_acquire);
+				const size_t slot = sizeof(dchar) / 2;
+				if(m && m->ready[slot].load(std::memory_order_acquire))
+					return static_cast<const dchar*>(m->text[slot]);
+				return nullptr;
+			}
+#endif
+
+			// Drops any memoized conversions (call whenever the text changes)
+			void forget() {
+#ifndef UTFSTRING_NO_MEMO
+				delete cache.exchange(nullptr);
+#endif
+			}
+
+			// Releases the internal text string according to how it was obtained
+			void release() {
+				if(owner) delete owner;
+				else if(deleter) deleter(text);
+				owner = nullptr;
+				text = nullptr;
+				forget();
+			}
+
+			// Internal code chunk to initialize internal text string/stringview ('extra' code units are reserved past the text)
+			template <typename dest>
+			void rawAssign(stringview<dest>& temp, size_t extra = 0) {
+				rawAssign(temp, std::is_same<dest, const ch*>(), extra);
+			}
 
-			// Internal code chunk to initialize internal text string/stringview
 			template <typename dest>
-			void rawAssign(stringview<dest>& temp) {
-				text = new ch[temp.codeunits<chartype>()];
+			void rawAssign(stringview<dest>& temp, std::false_type, size_t extra) {		// Transcode
+				size_t size = temp.codeunits<chartype>();
+				capacity = size + extra;
+				text = new ch[capacity];
 				temp.to<chartype>(utf_encoder(text));						// fill text
-				view.refocus(text, text + temp.codeunits<chartype>());
+				view.refocus(text, text + size);
+				deleter = &free_text;
+			}
+
+			void rawAssign(stringview<const ch*>& temp, std::true_type, size_t extra) {		// Same encoding, a single copy
+				size_t size = temp.codeunits();
+				capacity = size + extra;
+				text = new ch[capacity];
+				std::memcpy(text, temp.data(), temp.bytes());
+				view.refocus(text, text + size);
+				deleter = &free_text;
+			}
+
+			// Ends the text with a null unit, as literal construction does, if it doesn't already have one
+			// substr, splice and + count the last character from it. Borrowed or full buffers are copied first
+			void terminate() {
+				size_t size = view.codeunits();
+				if(size && text[size - 1] == ch(0)) return;
+
+				if(!owns() || capacity == size) {
+					ch* newText = new ch[size + 1];
+					if(size) std::memcpy(newText, text, size * sizeof(ch));
+
+					release();
+					text = newText;
+					capacity = size + 1;
+					deleter = &free_text;
+				}
+
+				text[size] = ch(0);
+				view.refocus(text, text + size + 1);
+			}
+
+			// Whether the view points into this string's buffer
+			bool overlaps(const stringview<const ch*>& piece) {
+				return !(piece.data() + piece.codeunits() <= text || text + capacity <= piece.data());
+			}
+			template <typename dest>
+			bool overlaps(const stringview<dest>&) { return false; }
+
+			// Internal code chunk to insert piece2 at idx_sp directly into this string's buffer (for r-value operations)
+			// Shifts the tail in place if the buffer is owned and has room, otherwise moves to a buffer 1.5x the new length
+			template <typename dest>
+			void rawSpliceInPlace(stringview<dest>& piece2,int idx_sp) {
+				size_t split = view.codeidx(idx_sp), size = view.codeunits(), n2 = piece2.codeunits<chartype>();
+
+				if(owns() && size + n2 <= capacity && !overlaps(piece2)) {
+					std::memmove(text + split + n2, text + split, (size - split) * sizeof(ch));
+					piece2.to<chartype>(text + split);
+					forget();
+				} else {
+					size_t room = (size + n2) + (size + n2) / 2;
+					ch* newText = new ch[room];
+					std::memcpy(newText, text, split * sizeof(ch));
+					piece2.to<chartype>(newText + split);
+					std::memcpy(newText + split + n2, text + split, (size - split) * sizeof(ch));
+
+					release();
+					text = newText;
+					capacity = room;
+					deleter = &free_text;
+				}
+
+				view.refocus(text, text + size + n2);
 			}
 
 			// Internal code chunk to handle the inserting of one string into another at a given index
@@ -114,24 +298,65 @@ namespace utf {
 			}
 			template <typename dchar>
 			string(string<dchar>& str) : view(0,0) {						// Encoding converter
+#ifndef UTFSTRING_NO_MEMO
+				if(const ch* _text = str.template memoized<ch>()) {			// copies str's conversion if it keeps one
+					stringview<const ch*> temp(_text, _text + str.template strsize<ch>());
+					rawAssign(temp);
+					return;
+				}
+#endif
 				rawAssign(str.view);
 			}
 
-			// Note: How to initialize with an std::string???
+			template <typename dchar>
+			string(const std::basic_string<dchar>& str) : view(0,0) {		// std::basic_string
+				auto temp = make_stringview(str);
+				rawAssign(temp, 1);
+				terminate();
+			}
+#ifdef UTF_HAS_STRING_VIEW
+			template <typename dchar>
+			string(std::basic_string_view<dchar> str) : view(0,0) {			// std::basic_string_view
+				auto temp = make_stringview(str);
+				rawAssign(temp, 1);
+				terminate();
+			}
+#endif
 
 			// move constructors
-			string(ch* start, ch* end) : text(start),view(start,end) {		// Char pointers
+			string(ch* start, ch* end) : text(start),view(start,end),deleter(&free_text),capacity(end - start) {		// Char pointers (allocated with new[])
 				start = nullptr;
 				end = nullptr;
 			}
 
-			string(string<ch>&& str) : text(str.text),view(0,0) {			// string r-value (I don't think this is used to often
+			string(string<ch>&& str) : text(str.text),view(0,0),deleter(str.deleter),capacity(str.capacity) {			// string r-value
 				view.refocus(str.view);
+				owner = str.owner;
 				str.text = nullptr;
+				str.view.refocus(nullptr, nullptr);
+				str.deleter = nullptr;
+				str.owner = nullptr;
+				str.capacity = 0;
+#ifndef UTFSTRING_NO_MEMO
+				cache = str.cache.exchange(nullptr);
+#endif
+			}
+
+			// adopting constructors (take ownership of an external buffer without copying)
+			// N counts the terminating null unit, as with literals. A buffer that doesn't end in one is copied once to add it
+			template <typename D>
+			string(std::unique_ptr<ch[], D> buf, size_t N) : text(buf.get()),view(text,text + N),deleter(nullptr),capacity(N) {
+				adopt(buf);
+				terminate();
+			}
+
+			// 'del' is called on the buffer when the string is done with it. Passing nullptr borrows the buffer instead
+			string(ch* buf, size_t N, void (*del)(ch*)) : text(buf),view(buf,buf + N),deleter(del),capacity(N) {
+				terminate();
 			}
 
 			// destructor
-			~string() { delete[] text; }
+			~string() { release(); }
 
 			// string info functions
 
@@ -141,22 +366,62 @@ namespace utf {
 			const char* encoding() { return priv_encode<chartype>(); }
 
 			// Gives the array size of the string in the specified encoding (Relies on an explicit template type)
+			// translates char -> utf8_t, char16_t -> utf16_t, etc. Read from the memo when cached<dchar>() has filled it
 			template <typename dchar = ch>
-			size_t strsize() { return view.codeunits<typename impl::encoding_for_size<sizeof(dchar)>::type>(); }	// translates char -> utf8_t, char16_t -> utf16_t, etc.
+			size_t strsize() {
+				typedef typename impl::encoding_for_size<sizeof(dchar)>::type dchartype;
+				if(sizeof(dchar) == sizeof(ch)) return view.codeunits();
+
+#ifndef UTFSTRING_NO_MEMO
+				if(memoized<dchar>()) return cache.load(std::memory_order_acquire)->size[sizeof(dchar) / 2];
+#endif
+				return view.template codeunits<dchartype>();
+			}
 			template <>	size_t strsize<utf8_t>() { return view.codeunits<utf8_t>(); }
 			template <>	size_t strsize<utf16_t>() { return view.codeunits<utf16_t>(); }
 			template <>	size_t strsize<utf32_t>() { return view.codeunits<utf32_t>(); }
 
 			// char string conversions
 
+#ifndef UTFSTRING_NO_MEMO
+			// Returns the internal text converted to the desired encoding (strsize<dchar>() code units)
+			// Opt-in memo: the conversion is done on the first call and kept with the string, so that later calls,
+			// text_as, strsize, == and the converting constructor reuse it. Safe to call from several threads
+			// The pointer belongs to the string and is valid until the string is destroyed or assigned to
+			template <typename dchar>
+			const dchar* cached() {
+				typedef typename impl::encoding_for_size<sizeof(dchar)>::type dchartype;
+				typedef typename impl::code_traits<dchartype>::codeunit_type unit;
+				if(sizeof(dchar) == sizeof(ch)) return reinterpret_cast<const dchar*>(text);
+
+				impl::memo& m = memo();
+				const size_t slot = sizeof(dchar) / 2;
+				std::call_once(m.filled[slot], [&] {
+					size_t size = view.template codeunits<dchartype>();
+					unit* _text = new unit[size];
+					view.template to<dchartype>(_text);
+					m.size[slot] = size;
+					m.text[slot] = _text;
+					m.ready[slot].store(true, std::memory_order_release);
+				});
+				return static_cast<const dchar*>(m.text[slot]);
+			}
+#endif
+
 			// Converts a copy of the string into a character array with the desired encoding
 			// Note: Currently only "work" on dchar = { char, char16_t, char32_t }
 			template <typename dchar>
 			dchar* text_as() {
 				typedef typename impl::encoding_for_size<sizeof(dchar)>::type dchartype;
 
-				dchar* _text = new dchar[view.codeunits<dchartype>()];
-				view.to<dchartype>(string<dchar>::utf_encoder(_text));
+				dchar* _text = new dchar[strsize<dchar>()];
+#ifndef UTFSTRING_NO_MEMO
+				if(const dchar* kept = memoized<dchar>()) {
+					std::memcpy(_text, kept, strsize<dchar>() * sizeof(dchar));
+					return _text;
+				}
+#endif
+				view.to<dchartype>(_text);
 				return _text;
 			}
 
@@ -177,25 +442,25 @@ namespace utf {
 			// Changes the internal text to the passed string
 			template <typename dchar,size_t N>
 			void assign(const dchar(&_text)[N]) {								// Text Literal
-				delete[] text;
+				release();
 				rawAssign(make_stringview(_text));
 			}
 
 			template <typename dchar>
 			void assign(const dchar* _text, size_t N) {							// C-style strings
-				delete[] text;
+				release();
 				rawAssign(make_stringview(_text,_text + N));
 			}
 
 			template <typename dchar>
 			void assign(string<dchar>& str) {									// Encoding converter
-				delete[] text;
+				release();
 				rawAssign(str.view);
 			}
 
 			// Currently deprecated
 			void assign(std::string& str) {
-				delete[] text;
+				release();
 				// doesn't append ending character?
 				rawAssign(make_stringview(str.begin(), str.end()));
 			}
@@ -208,16 +473,39 @@ namespace utf {
 				* This function also provides the ability to index from the back of the string by using a "negative" index
 				* The function will throw an error if the actual indices given do not represent a valid substring
 				*/
-			string<ch> substr(int idx_b = 1,int idx_e = -1) {
+			string<ch> substr(int idx_b = 1,int idx_e = -1) & {
 				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
 
 				auto sub = make_stringview(text + view.codeidx(idx_b), text + view.codeidx(idx_e) + (idx_e > 0));
 				auto end = make_stringview(text + view.codeidx(-1), text + view.codeidx(0));
 
+				// same encoding, so the code units are copied as they are
 				ch* substr = new ch[sub.codeunits() + end.codeunits()];
-				end.to<chartype>(sub.to<chartype>(utf_encoder(substr)));
+				std::memcpy(substr, sub.data(), sub.bytes());
+				std::memcpy(substr + sub.codeunits(), end.data(), end.bytes());
+
+				return string<ch>(substr, substr + sub.codeunits() + end.codeunits());
+			}
 
-				return string<ch>(substr, substr + sub.codeunits<chartype>() + end.codeunits<chartype>());
+			/*
+				* The r-value overloads of substr, cut, splice and + reuse the string's own buffer when it is owned
+				* Text is shifted in place and the buffer is moved into the result, so no allocation is made
+				* unless a splice needs more room than the buffer has. A grown buffer is 1.5x the new length, leaving slack for later appends
+				* Inside these overloads *this is an l-value, so a plain call falls back to the copying version
+				*/
+			string<ch> substr(int idx_b = 1,int idx_e = -1) && {
+				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
+
+				size_t first = view.codeidx(idx_b), last = view.codeidx(idx_e) + (idx_e > 0), tail = view.codeidx(-1);
+				if(!owns() || last > tail) return substr(idx_b, idx_e);		// the range runs into the last character
+
+				// the range moves to the front and the last character (the terminator) follows it
+				size_t sub = last - first, end = view.codeunits() - tail;
+				std::memmove(text, text + first, sub * sizeof(ch));
+				std::memmove(text + sub, text + tail, end * sizeof(ch));
+				view.refocus(text, text + sub + end);
+				forget();
+				return string<ch>(std::move(*this));
 			}
 
 			string<ch> copy() { return substr(); }				// Couldn't I just return *this; ???
@@ -228,7 +516,7 @@ namespace utf {
 
 			// Splices (Do I really need all these overloads ???)
 			template <typename dchar>
-			string<ch> splice(dchar* _text, size_t N, int idx_sp = -1, int idx_b = 1, int idx_e = -1) {
+			string<ch> splice(dchar* _text, size_t N, int idx_sp = -1, int idx_b = 1, int idx_e = -1) & {
 				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
 
 				auto temp = make_stringview(_text, _text + N);
@@ -236,7 +524,7 @@ namespace utf {
 			}
 
 			template<typename dchar,size_t N>
-			string<ch> splice(dchar(&_text)[N], int idx_sp = -1, int idx_b = 1, int idx_e = -1) {
+			string<ch> splice(dchar(&_text)[N], int idx_sp = -1, int idx_b = 1, int idx_e = -1) & {
 				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
 
 				auto temp = make_stringview(_text);
@@ -244,15 +532,44 @@ namespace utf {
 			}
 
 			template <typename dchar>
-			string<ch> splice(string<dchar>& str, int idx_sp = -1, int idx_b = 1, int idx_e = -1) {
+			string<ch> splice(string<dchar>& str, int idx_sp = -1, int idx_b = 1, int idx_e = -1) & {
 				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
 
 				return rawSplice(make_stringview(str.text + str.view.codeidx(idx_b),
 					str.text + str.view.codeidx(idx_e) + (idx_e > 0)), idx_sp);
 			}
 
+			template <typename dchar>
+			string<ch> splice(dchar* _text, size_t N, int idx_sp = -1, int idx_b = 1, int idx_e = -1) && {
+				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
+
+				auto temp = make_stringview(_text, _text + N);
+				auto piece = make_stringview(_text + temp.codeidx(idx_b), _text + temp.codeidx(idx_e) + (idx_e > 0));
+				rawSpliceInPlace(piece, idx_sp);
+				return string<ch>(std::move(*this));
+			}
+
+			template<typename dchar,size_t N>
+			string<ch> splice(dchar(&_text)[N], int idx_sp = -1, int idx_b = 1, int idx_e = -1) && {
+				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
+
+				auto temp = make_stringview(_text);
+				auto piece = make_stringview(_text + temp.codeidx(idx_b), _text + temp.codeidx(idx_e) + (idx_e > 0));
+				rawSpliceInPlace(piece, idx_sp);
+				return string<ch>(std::move(*this));
+			}
+
+			template <typename dchar>
+			string<ch> splice(string<dchar>& str, int idx_sp = -1, int idx_b = 1, int idx_e = -1) && {
+				if(!is_valid_range(idx_b, idx_e)) throw("Error: invalid index range");
+
+				auto piece = make_stringview(str.text + str.view.codeidx(idx_b), str.text + str.view.codeidx(idx_e) + (idx_e > 0));
+				rawSpliceInPlace(piece, idx_sp);
+				return string<ch>(std::move(*this));
+			}
+
 			// Removes the specified substring
-			string<ch> cut(int idx_b = 1,int idx_e = -1) {
+			string<ch> cut(int idx_b = 1,int idx_e = -1) & {
 				auto piece1 = make_stringview(text,text + view.codeidx(idx_b));
 				auto piece2 = make_stringview(text + view.codeidx(idx_e) + (idx_e > 0),text + view.codeidx(0));
 
@@ -262,19 +579,30 @@ namespace utf {
 				return string<ch>(str,str + piece1.codeunits() + piece2.codeunits());
 			}
 
+			string<ch> cut(int idx_b = 1,int idx_e = -1) && {
+				size_t split = view.codeidx(idx_b), rest = view.codeidx(idx_e) + (idx_e > 0), size = view.codeunits();
+				if(!owns() || rest < split) return cut(idx_b, idx_e);
+
+				std::memmove(text + split, text + rest, (size - rest) * sizeof(ch));
+				view.refocus(text, text + split + size - rest);
+				forget();
+				return string<ch>(std::move(*this));
+			}
+
 			// boolean operators
 
 			// Performs an arraywise comparison of two strings. Performs any necessary conversions first
 			template <typename dchar>
 			bool operator==(string<dchar>& str) {
 				if(str.strsize<ch>() == strsize()) {
+#ifndef UTFSTRING_NO_MEMO
+					if(const ch* kept = str.template memoized<ch>())
+						return std::memcmp(kept, text, strsize() * sizeof(ch)) == 0;
+#endif
 					ch* comp = str.text_as<ch>();
-
-					for(auto i = 0; i != strsize(); ++i)
-						if(comp[i] != text[i])
-							return false;
-
-					return true;
+					bool same = std::memcmp(comp, text, strsize() * sizeof(ch)) == 0;
+					delete[] comp;
+					return same;
 				}
 
 				return false;
@@ -295,10 +623,23 @@ namespace utf {
 				return *this;
 			}
 
-			string<ch>& operator=(string<ch>&& str) {				// string r-value (I don't have any functions that can produce this though)
+			string<ch>& operator=(string<ch>&& str) {				// string r-value (takes over str's buffer)
+				if(this == &str) return *this;
+
+				release();
 				text = str.text;
-				view = str.view;
+				view.refocus(str.view);
+				deleter = str.deleter;
+				owner = str.owner;
+				capacity = str.capacity;
+#ifndef UTFSTRING_NO_MEMO
+				cache = str.cache.exchange(nullptr);
+#endif
 				str.text = nullptr;
+				str.view.refocus(nullptr, nullptr);
+				str.deleter = nullptr;
+				str.owner = nullptr;
+				str.capacity = 0;
 				return *this;
 			}
 
@@ -312,15 +653,25 @@ namespace utf {
 
 			// Appends the given string to the current string (wraps splice)
 			template <typename dchar>
-			string<ch> operator+(string<dchar>& str) {
+			string<ch> operator+(string<dchar>& str) & {
 				return splice(str);
 			}
 
 			template <typename dchar, size_t N>
-			string<ch> operator+(const dchar(&str)[N]) {				// Couldn't I just provide an overload for string/string&&
+			string<ch> operator+(const dchar(&str)[N]) & {
 				return splice(str,N);
 			}
 
+			template <typename dchar>
+			string<ch> operator+(string<dchar>& str) && {				// appends in place, see substr
+				return std::move(*this).splice(str);
+			}
+
+			template <typename dchar, size_t N>
+			string<ch> operator+(const dchar(&str)[N]) && {
+				return std::move(*this).splice(str,N);
+			}
+
 			// other functions
 				
 			// Allows iteration over the string (Add const and c_begin, etc. ???)
@@ -351,12 +702,80 @@ namespace std {
 	auto end(utf::string<ch>& str) -> decltype(str.end()) { return str.end(); }
 
 	// Overloads the stream operator (for usage in cout, etc.)
-	// Currently relies on explicit
+	// Transcodes into a small stack buffer and hands each full chunk straight to the stream buffer
+	// The terminating null unit is not written. Pads to width() with fill() like the standard inserters (width counts code units)
 	template<typename ch,typename dchar>
 	basic_ostream<dchar>& operator<<(basic_ostream<dchar>& str, utf::string<ch>& text) {
-		str << text.text_as<dchar>();
+		typedef typename utf::impl::encoding_for_size<sizeof(dchar)>::type dchartype;
+		const streamsize chunk = 256;
+
+		typename basic_ostream<dchar>::sentry ok(str);
+		if(!ok) return str;
+
+		const ch* _text = static_cast<const ch*>(text);
+		size_t size = text.strsize();
+		if(size && _text[size - 1] == ch(0)) --size;
+		auto view = utf::make_stringview(_text, _text + size);
+
+		// the text is only measured when there is a width to pad to
+		streamsize pad = 0;
+		if(str.width() > 0) {
+			streamsize units = view.template codeunits<dchartype>();
+			if(str.width() > units) pad = str.width() - units;
+		}
+		bool left = (str.flags() & ios_base::adjustfield) == ios_base::left;
+		str.width(0);
+
+		auto fill = [&](streamsize n) {
+			for(; n; --n)
+				if(basic_ostream<dchar>::traits_type::eq_int_type(str.rdbuf()->sputc(str.fill()), basic_ostream<dchar>::traits_type::eof()))
+					return false;
+			return true;
+		};
+
+		if(!left && !fill(pad)) {
+			str.setstate(ios_base::badbit);
+			return str;
+		}
+
+		dchar buf[chunk];
+		dchar* pos = buf;
+		for(auto cp : view) {
+			if(buf + chunk - pos < 4) {								// no room for the longest encoding
+				if(str.rdbuf()->sputn(buf, pos - buf) != pos - buf) {
+					str.setstate(ios_base::badbit);
+					return str;
+				}
+				pos = buf;
+			}
+			pos = utf::impl::code_traits<dchartype>::encode(cp, pos);
+		}
+
+		if(str.rdbuf()->sputn(buf, pos - buf) != pos - buf || (left && !fill(pad)))
+			str.setstate(ios_base::badbit);
+		return str;
+	}
+
+	// Reads a whitespace delimited word from the stream and converts it to the string's encoding
+	template<typename ch,typename dchar>
+	basic_istream<dchar>& operator>>(basic_istream<dchar>& str, utf::string<ch>& text) {
+		basic_string<dchar> buf;
+		if(str >> buf)
+			text.assign(buf.c_str(), buf.size() + 1);			// keeps the terminating null unit
 		return str;
 	}
 
-	//add overload for insertion and getline
+	// Reads everything up to 'delim' from the stream and converts it to the string's encoding
+	template<typename ch,typename dchar>
+	basic_istream<dchar>& getline(basic_istream<dchar>& str, utf::string<ch>& text, dchar delim) {
+		basic_string<dchar> buf;
+		if(getline(str, buf, delim))
+			text.assign(buf.c_str(), buf.size() + 1);
+		return str;
+	}
+
+	template<typename ch,typename dchar>
+	basic_istream<dchar>& getline(basic_istream<dchar>& str, utf::string<ch>& text) {
+		return getline(str, text, str.widen('\n'));
+	}
 }
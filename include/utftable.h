@@ -0,0 +1,306 @@
+//          Copyright Grayson Hooper, 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//         http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "utfbatch.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace utf {
+
+	/*
+		* Binary layout of a serialized string table (all values in native byte order)
+		*
+		*   header                      32 bytes
+		*   entry[count]                40 bytes each
+		*   text and sparse indices     each block starts on an 8 byte boundary
+		*
+		* Every entry records its own encoding, so one table can mix UTF-8, UTF-16 and UTF-32 strings.
+		* The sparse index of an entry holds the code unit offset of every 'stride'th code point,
+		* which lets codeidx skip to within 'stride' code points of the target.
+		* All positions are byte offsets from the start of the table, so the table can be used
+		* directly from a memory mapped file without any fixups.
+		*/
+
+	namespace impl {
+
+		struct table_header {
+			char magic[4];				// "UTFT"
+			uint32_t version;
+			uint32_t count;				// number of entries
+			uint32_t stride;			// code points between sparse index marks (0 = no index)
+			uint64_t size;				// size of the whole table in bytes
+			uint32_t checksum;			// FNV-1a of count, stride and size, then everything after the header
+			uint32_t byteorder;			// table_byteorder as written by the producing machine
+		};
+
+		struct table_entry {
+			uint64_t offset;			// byte offset of the code units
+			uint64_t codeunits;
+			uint64_t codepoints;
+			uint64_t index;				// byte offset of the sparse index (0 = none)
+			uint32_t charsize;			// code unit size: 1, 2 or 4
+			uint32_t marks;				// number of sparse index entries
+		};
+
+		const uint32_t table_version = 2;
+		const uint32_t table_byteorder = 0x01020304;
+
+		inline uint32_t fnv1a(const unsigned char* first,const unsigned char* last,uint32_t hash = 2166136261u) {
+			for(; first != last; ++first)
+				hash = (hash ^ *first) * 16777619u;
+			return hash;
+		}
+
+		// Checksum of a table image. The header fields that locate the data are covered along with the data itself
+		inline uint32_t table_checksum(const table_header& header,const unsigned char* image) {
+			const unsigned char* count = reinterpret_cast<const unsigned char*>(&header.count);
+			const unsigned char* size = reinterpret_cast<const unsigned char*>(&header.size);
+			uint32_t hash = fnv1a(count,count + sizeof(header.count) + sizeof(header.stride));
+			hash = fnv1a(size,size + sizeof(header.size),hash);
+			return fnv1a(image + sizeof(table_header),image + header.size,hash);
+		}
+
+		inline size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+		// Fills 'marks' with the code unit offset of code point k * stride, for k = 1..count
+		template <typename Iter,typename E>
+		void table_marks(const stringview<Iter,E>& view,uint64_t* marks,size_t count,uint32_t stride) {
+			Iter _text = view.data(), end = _text + view.codeunits();
+			size_t pos = 0;
+			codepoint_type cp;
+			for(size_t k = 0; k != count; ++k) {
+				for(uint32_t n = stride; n; --n)
+					pos += code_traits<E>::read(_text + pos,end,cp);		// steps like codepoints() does, invalid text included
+				marks[k] = pos;
+			}
+		}
+	}
+
+	/*
+		* Serializes the strings in [first, last) into a table image. Each string keeps its encoding
+		* The elements may be utf::strings, stringviews or std::basic_strings (see transcode_batch)
+		* 'stride' controls the sparse code point index. 0 disables it
+		*/
+	template <typename FwdIt>
+	std::vector<char> make_table(FwdIt first,FwdIt last,uint32_t stride = 0) {
+		size_t count = std::distance(first,last);
+		std::vector<impl::table_entry> entries(count);
+
+		// first pass: measure and lay out every block
+		size_t pos = sizeof(impl::table_header) + count * sizeof(impl::table_entry);
+		size_t i = 0;
+		for(FwdIt it = first; it != last; ++it, ++i) {
+			auto view = impl::view_of(*it);
+			impl::table_entry& e = entries[i];
+
+			e.charsize = sizeof(*view.data());
+			e.codeunits = view.codeunits();
+			e.codepoints = view.codepoints();
+			e.offset = pos;
+			pos = impl::align8(pos + view.bytes());
+
+			e.marks = stride ? static_cast<uint32_t>(e.codepoints / stride) : 0;
+			e.index = e.marks ? pos : 0;
+			pos += e.marks * sizeof(uint64_t);
+		}
+
+		std::vector<char> image(pos,0);
+		impl::table_header header = { { 'U','T','F','T' },impl::table_version,static_cast<uint32_t>(count),stride,pos,0,impl::table_byteorder };
+		if(count)
+			std::memcpy(&image[sizeof(header)],&entries[0],count * sizeof(impl::table_entry));
+
+		// second pass: copy the text and build the sparse indices
+		i = 0;
+		for(FwdIt it = first; it != last; ++it, ++i) {
+			auto view = impl::view_of(*it);
+			const impl::table_entry& e = entries[i];
+
+			std::memcpy(&image[e.offset],view.data(),view.bytes());
+
+			if(e.marks)
+				impl::table_marks(view,reinterpret_cast<uint64_t*>(&image[0] + e.index),e.marks,stride);
+		}
+
+		header.checksum = impl::table_checksum(header,reinterpret_cast<const unsigned char*>(&image[0]));
+		std::memcpy(&image[0],&header,sizeof(header));
+		return image;
+	}
+
+	/*
+		* Read-only access to a serialized string table that lives in memory (usually a mapped file)
+		* Loading only checks the header. Strings are handed out as stringviews straight into the table
+		* Offsets and sizes are bounds checked on every access. Call verify() to check the checksum when the source is not trusted
+		*/
+	class table {
+		private:
+			const char* base;
+			size_t length;
+
+			const impl::table_header& header() const {
+				return *reinterpret_cast<const impl::table_header*>(base);
+			}
+
+			const impl::table_entry& entry(size_t i) const {
+				if(i >= size()) throw("Error: invalid table index");
+				return reinterpret_cast<const impl::table_entry*>(base + sizeof(impl::table_header))[i];
+			}
+
+		protected:
+			table() : base(nullptr),length(0) { }
+
+			void load(const void* data,size_t size) {
+				base = static_cast<const char*>(data);
+				length = size;
+
+				if(length < sizeof(impl::table_header) || std::memcmp(header().magic,"UTFT",4) != 0)
+					throw("Error: not a string table");
+				if(header().version != impl::table_version || header().byteorder != impl::table_byteorder)
+					throw("Error: unsupported string table");
+				if(header().size > length || header().size < sizeof(impl::table_header)
+					|| header().count > (header().size - sizeof(impl::table_header)) / sizeof(impl::table_entry))
+					throw("Error: truncated string table");
+			}
+
+		public:
+			table(const void* data,size_t size) { load(data,size); }
+
+			// number of strings in the table
+			size_t size() const { return header().count; }
+
+			// Recomputes the checksum over the table
+			bool verify() const {
+				return impl::table_checksum(header(),reinterpret_cast<const unsigned char*>(base)) == header().checksum;
+			}
+
+			// code unit size of string 'i' (1, 2 or 4)
+			int charsize(size_t i) const { return entry(i).charsize; }
+
+			const char* encoding(size_t i) const {
+				switch(charsize(i)) {
+					case 1: return "UTF-8";
+					case 2: return "UTF-16";
+					default: return "UTF-32";
+				}
+			}
+
+			size_t codeunits(size_t i) const { return static_cast<size_t>(entry(i).codeunits); }
+			size_t codepoints(size_t i) const { return static_cast<size_t>(entry(i).codepoints); }
+
+			// Non-owning view of string 'i'. Throws if 'ch' does not match the stored encoding
+			// or if the entry points outside the table (the text itself is only checked by verify)
+			template <typename ch>
+			stringview<const ch*> get(size_t i) const {
+				const impl::table_entry& e = entry(i);
+				if(e.charsize != sizeof(ch)) throw("Error: incorrect coding specified");
+				if(e.offset % sizeof(ch) || e.offset > header().size || e.codeunits > (header().size - e.offset) / sizeof(ch))
+					throw("Error: corrupt string table");
+
+				const ch* _text = reinterpret_cast<const ch*>(base + e.offset);
+				return stringview<const ch*>(_text,_text + e.codeunits);
+			}
+
+			// Code unit position of the code point 'n' (0-based) of string 'i', using the sparse index when present
+			template <typename ch>
+			size_t codeidx(size_t i,size_t n) const {
+				typedef typename impl::encoding_for_size<sizeof(ch)>::type chartype;
+
+				const impl::table_entry& e = entry(i);
+				stringview<const ch*> view = get<ch>(i);
+				if(n >= e.codepoints) return view.codeunits();
+
+				size_t pos = 0, k = (e.marks && header().stride) ? n / header().stride : 0;
+				if(k) {
+					if(e.index % sizeof(uint64_t) || e.index > header().size || e.marks > (header().size - e.index) / sizeof(uint64_t))
+						throw("Error: corrupt string table");
+					if(k > e.marks) k = e.marks;
+
+					pos = static_cast<size_t>(reinterpret_cast<const uint64_t*>(base + e.index)[k - 1]);
+					if(pos > view.codeunits()) throw("Error: corrupt string table");
+					n -= k * header().stride;
+				}
+
+				const ch* end = view.data() + view.codeunits();
+				codepoint_type cp;
+				for(; n && pos < view.codeunits(); --n)
+					pos += impl::code_traits<chartype>::read(view.data() + pos,end,cp);
+				return pos;
+			}
+	};
+
+	/*
+		* A table read from a memory mapped file. The mapping is released with the object
+		*/
+	class mapped_table : public table {
+		private:
+#if defined(_WIN32)
+			HANDLE file, mapping;
+#endif
+			void* view;
+			size_t bytes;
+
+			mapped_table(const mapped_table&);
+			mapped_table& operator=(const mapped_table&);
+
+			void unmap() {
+#if defined(_WIN32)
+				if(view) UnmapViewOfFile(view);
+				if(mapping) CloseHandle(mapping);
+				if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+				if(view) munmap(view,bytes);
+#endif
+			}
+
+		public:
+			explicit mapped_table(const char* path) : view(nullptr),bytes(0) {
+#if defined(_WIN32)
+				mapping = nullptr;
+				file = CreateFileA(path,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+				LARGE_INTEGER size;
+				if(file != INVALID_HANDLE_VALUE && GetFileSizeEx(file,&size)) {
+					bytes = static_cast<size_t>(size.QuadPart);
+					mapping = CreateFileMappingA(file,nullptr,PAGE_READONLY,0,0,nullptr);
+					if(mapping) view = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+				}
+#else
+				int fd = open(path,O_RDONLY);
+				struct stat st;
+				if(fd >= 0 && fstat(fd,&st) == 0 && st.st_size > 0) {
+					bytes = static_cast<size_t>(st.st_size);
+					view = mmap(nullptr,bytes,PROT_READ,MAP_SHARED,fd,0);
+					if(view == MAP_FAILED) view = nullptr;
+				}
+				if(fd >= 0) close(fd);
+#endif
+				if(!view) {
+					unmap();
+					throw("Error: could not map string table");
+				}
+
+				try {
+					load(view,bytes);
+				} catch(...) {
+					unmap();
+					throw;
+				}
+			}
+
+			~mapped_table() { unmap(); }
+	};
+
+}
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+#          Copyright Grayson Hooper, 2013.
+# Distributed under the Boost Software License, Version 1.0.
+#    (See accompanying file LICENSE_1_0.txt or copy at
+#         http://www.boost.org/LICENSE_1_0.txt)
+
+"""Generates include/utf_grapheme_tables.h, the grapheme break property tables used by utfgrapheme.h
+
+Usage:
+    gen_grapheme_tables.py [--ucd DIR] [-o include/utf_grapheme_tables.h]
+
+With --ucd, the properties are read from GraphemeBreakProperty.txt and emoji-data.txt in DIR
+(https://www.unicode.org/Public/UCD/latest/ucd/). Without it they are derived from Python's
+unicodedata module following the definitions in UAX #29, table 2.
+
+The output is a two-stage table: stage1[cp >> 7] selects a 128 entry block of stage2, and identical
+blocks are shared, which keeps the whole table under 32KB.
+"""
+
+import argparse
+import os
+import sys
+import unicodedata
+
+PROPERTIES = ['Other', 'CR', 'LF', 'Control', 'Extend', 'ZWJ', 'Regional_Indicator', 'Prepend',
+              'SpacingMark', 'L', 'V', 'T', 'LV', 'LVT', 'Extended_Pictographic']
+
+BLOCK = 128
+LIMIT = 0x110000
+
+# Lists UAX #29 takes from other UCD files that unicodedata doesn't expose
+OTHER_GRAPHEME_EXTEND = [(0x09BE, 0x09BE), (0x09D7, 0x09D7), (0x0B3E, 0x0B3E), (0x0B57, 0x0B57),
+                         (0x0BBE, 0x0BBE), (0x0BD7, 0x0BD7), (0x0CC2, 0x0CC2), (0x0CD5, 0x0CD6),
+                         (0x0D3E, 0x0D3E), (0x0D57, 0x0D57), (0x0DCF, 0x0DCF), (0x0DDF, 0x0DDF),
+                         (0x1B35, 0x1B35), (0x200C, 0x200C), (0x302E, 0x302F), (0xFF9E, 0xFF9F),
+                         (0x1133E, 0x1133E), (0x11357, 0x11357), (0x114B0, 0x114B0), (0x114BD, 0x114BD),
+                         (0x115AF, 0x115AF), (0x11930, 0x11930), (0x1D165, 0x1D165), (0x1D16E, 0x1D172),
+                         (0xE0020, 0xE007F)]
+
+EMOJI_MODIFIER = [(0x1F3FB, 0x1F3FF)]
+
+PREPEND = [(0x0600, 0x0605), (0x06DD, 0x06DD), (0x070F, 0x070F), (0x0890, 0x0891), (0x08E2, 0x08E2),
+           (0x0D4E, 0x0D4E), (0x110BD, 0x110BD), (0x110CD, 0x110CD), (0x111C2, 0x111C3),
+           (0x1193F, 0x1193F), (0x11941, 0x11941), (0x11A3A, 0x11A3A), (0x11A84, 0x11A89),
+           (0x11D46, 0x11D46)]
+
+# Spacing marks that are not SpacingMark for grapheme breaking
+NOT_SPACING_MARK = [(0x102B, 0x102C), (0x1038, 0x1038), (0x1062, 0x1064), (0x1067, 0x106D),
+                    (0x1083, 0x1083), (0x1087, 0x108C), (0x108F, 0x108F), (0x109A, 0x109C),
+                    (0x1A61, 0x1A61), (0x1A63, 0x1A64), (0xAA7B, 0xAA7B), (0xAA7D, 0xAA7D),
+                    (0x11720, 0x11721)]
+
+EXTENDED_PICTOGRAPHIC = [(0x00A9, 0x00A9), (0x00AE, 0x00AE), (0x203C, 0x203C), (0x2049, 0x2049),
+                         (0x2122, 0x2122), (0x2139, 0x2139), (0x2194, 0x2199), (0x21A9, 0x21AA),
+                         (0x231A, 0x231B), (0x2328, 0x2328), (0x2388, 0x2388), (0x23CF, 0x23CF),
+                         (0x23E9, 0x23F3), (0x23F8, 0x23FA), (0x24C2, 0x24C2), (0x25AA, 0x25AB),
+                         (0x25B6, 0x25B6), (0x25C0, 0x25C0), (0x25FB, 0x25FE), (0x2600, 0x2605),
+                         (0x2607, 0x2612), (0x2614, 0x2685), (0x2690, 0x2705), (0x2708, 0x2712),
+                         (0x2714, 0x2714), (0x2716, 0x2716), (0x271D, 0x271D), (0x2721, 0x2721),
+                         (0x2728, 0x2728), (0x2733, 0x2734), (0x2744, 0x2744), (0x2747, 0x2747),
+                         (0x274C, 0x274C), (0x274E, 0x274E), (0x2753, 0x2755), (0x2757, 0x2757),
+                         (0x2763, 0x2767), (0x2795, 0x2797), (0x27A1, 0x27A1), (0x27B0, 0x27B0),
+                         (0x27BF, 0x27BF), (0x2934, 0x2935), (0x2B05, 0x2B07), (0x2B1B, 0x2B1C),
+                         (0x2B50, 0x2B50), (0x2B55, 0x2B55), (0x3030, 0x3030), (0x303D, 0x303D),
+                         (0x3297, 0x3297), (0x3299, 0x3299), (0x1F000, 0x1F0FF), (0x1F10D, 0x1F10F),
+                         (0x1F12F, 0x1F12F), (0x1F16C, 0x1F171), (0x1F17E, 0x1F17F), (0x1F18E, 0x1F18E),
+                         (0x1F191, 0x1F19A), (0x1F1AD, 0x1F1E5), (0x1F201, 0x1F20F), (0x1F21A, 0x1F21A),
+                         (0x1F22F, 0x1F22F), (0x1F232, 0x1F23A), (0x1F23C, 0x1F23F), (0x1F249, 0x1F3FA),
+                         (0x1F400, 0x1F53D), (0x1F546, 0x1F64F), (0x1F680, 0x1F6FF), (0x1F774, 0x1F77F),
+                         (0x1F7D5, 0x1F7FF), (0x1F80C, 0x1F80F), (0x1F848, 0x1F84F), (0x1F85A, 0x1F85F),
+                         (0x1F888, 0x1F88F), (0x1F8AE, 0x1F8FF), (0x1F90C, 0x1F93A), (0x1F93C, 0x1F945),
+                         (0x1F947, 0x1FAFF), (0x1FC00, 0x1FFFD)]
+
+
+def mark(props, ranges, value):
+    for first, last in ranges:
+        for cp in range(first, last + 1):
+            props[cp] = value
+
+
+def in_ranges(cp, ranges):
+    return any(first <= cp <= last for first, last in ranges)
+
+
+def derive():
+    """Derives the property of every code point from unicodedata (UAX #29, table 2)"""
+    props = [0] * LIMIT
+    index = {name: i for i, name in enumerate(PROPERTIES)}
+
+    for cp in range(LIMIT):
+        gc = unicodedata.category(chr(cp))
+        if gc in ('Mn', 'Me'):
+            props[cp] = index['Extend']
+        elif gc == 'Mc' and not in_ranges(cp, NOT_SPACING_MARK):
+            props[cp] = index['SpacingMark']
+        elif gc in ('Zl', 'Zp', 'Cc', 'Cf'):
+            props[cp] = index['Control']
+        elif gc == 'Cn' and 0xE0000 <= cp <= 0xE0FFF:		# unassigned default ignorables
+            props[cp] = index['Control']
+
+    mark(props, [(0x0E33, 0x0E33), (0x0EB3, 0x0EB3)], index['SpacingMark'])
+    mark(props, PREPEND, index['Prepend'])
+    mark(props, OTHER_GRAPHEME_EXTEND, index['Extend'])
+    mark(props, EMOJI_MODIFIER, index['Extend'])
+    mark(props, [(0x1F1E6, 0x1F1FF)], index['Regional_Indicator'])
+    mark(props, [(0x1100, 0x115F), (0xA960, 0xA97C)], index['L'])
+    mark(props, [(0x1160, 0x11A7), (0xD7B0, 0xD7C6)], index['V'])
+    mark(props, [(0x11A8, 0x11FF), (0xD7CB, 0xD7FB)], index['T'])
+    for cp in range(0xAC00, 0xD7A4):
+        props[cp] = index['LV'] if (cp - 0xAC00) % 28 == 0 else index['LVT']
+    for first, last in EXTENDED_PICTOGRAPHIC:
+        for cp in range(first, last + 1):
+            if props[cp] == 0:
+                props[cp] = index['Extended_Pictographic']
+
+    props[0x000D] = index['CR']
+    props[0x000A] = index['LF']
+    props[0x200D] = index['ZWJ']
+    return props
+
+
+def parse(path, wanted):
+    """Yields (first, last, property) from a UCD property file"""
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            cps, prop = [field.strip() for field in line.split(';')[:2]]
+            if prop not in wanted:
+                continue
+            first, _, last = cps.partition('..')
+            yield int(first, 16), int(last or first, 16), prop
+
+
+def read_ucd(directory):
+    props = [0] * LIMIT
+    index = {name: i for i, name in enumerate(PROPERTIES)}
+    for first, last, prop in parse(os.path.join(directory, 'GraphemeBreakProperty.txt'), index):
+        mark(props, [(first, last)], index[prop])
+    for first, last, prop in parse(os.path.join(directory, 'emoji-data.txt'), {'Extended_Pictographic'}):
+        for cp in range(first, last + 1):
+            if props[cp] == 0:
+                props[cp] = index[prop]
+    return props
+
+
+def emit(props, source, out):
+    blocks, stage1, stage2 = {}, [], []
+    for start in range(0, LIMIT, BLOCK):
+        block = tuple(props[start:start + BLOCK])
+        if block not in blocks:
+            blocks[block] = len(blocks)
+            stage2.extend(block)
+        stage1.append(blocks[block])
+
+    def rows(values, width):
+        for i in range(0, len(values), width):
+            yield '\t\t\t' + ','.join(str(v) for v in values[i:i + width]) + ','
+
+    out.write('// Generated by tools/gen_grapheme_tables.py from %s. Do not edit\n\n' % source)
+    out.write('#pragma once\n\n')
+    out.write('namespace utf {\n\n\tnamespace impl {\n\n')
+    out.write('\t\t// Grapheme_Cluster_Break values (plus Extended_Pictographic), in table order\n')
+    out.write('\t\tenum grapheme_break {\n')
+    for name in PROPERTIES:
+        out.write('\t\t\tgb_%s,\n' % name.lower())
+    out.write('\t\t};\n\n')
+    out.write('\t\tconst unsigned grapheme_block = %d;\n\n' % BLOCK)
+    out.write('\t\t// stage1[cp / grapheme_block] is the block of stage2 that holds cp\n')
+    index_type = 'unsigned char' if len(blocks) <= 256 else 'unsigned short'
+    out.write('\t\tconst %s grapheme_stage1[%d] = {\n' % (index_type, len(stage1)))
+    out.write('\n'.join(rows(stage1, 32)) + '\n\t\t};\n\n')
+    out.write('\t\tconst unsigned char grapheme_stage2[%d] = {\n' % len(stage2))
+    out.write('\n'.join(rows(stage2, 64)) + '\n\t\t};\n')
+    out.write('\t}\n}\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--ucd', help='directory holding GraphemeBreakProperty.txt and emoji-data.txt')
+    parser.add_argument('-o', '--output', default=os.path.join(os.path.dirname(__file__), '..', 'include', 'utf_grapheme_tables.h'))
+    args = parser.parse_args()
+
+    if args.ucd:
+        props, source = read_ucd(args.ucd), 'the UCD files in ' + os.path.basename(os.path.abspath(args.ucd))
+    else:
+        props, source = derive(), 'Python unicodedata %s' % unicodedata.unidata_version
+
+    with open(args.output, 'w', newline='\n') as out:
+        emit(props, source, out)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())